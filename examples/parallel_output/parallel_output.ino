@@ -1,19 +1,23 @@
-
 /*
  * Copyright (c) 2021 Jostein Løwer 
  *
  * SPDX-License-Identifier: BSD-3-Clause
  * 
  * Description: 
- * Starts a 8 DMX Output on GPIO pins 0-7 
+ * Starts a 8 DMX Output on GPIO pins 0-7 and sends
+ * the universes on all outputs in sync
  */
 
 #include <Arduino.h>
 #include <DmxOutput.h>
+#include <DmxSystem.h>
 
 // Declare 8 instances of the DMX output
 DmxOutput dmxOutputs[8];
 
+// Declare a DMX system that starts all 8 outputs at once
+DmxSystem dmxSystem;
+
 // Create a universe that we want to send in parallel on all 8 outputs.
 // The universe must be maximum 512 bytes + 1 byte for the start
 #define UNIVERSE_LENGTH 512
@@ -25,32 +29,32 @@ void setup()
     // Only 4 outputs can run on a single PIO instance, so
     // the 8 outputs are divided onto the two PIO instances
     // pio0 and pio1
+    DmxOutputConfig configs[8];
 
-    for (int i = 0; i < 4; i++)
+    for (int i = 0; i < 8; i++)
     {
-        dmxOutputs[i].begin(i, pio0);
+        configs[i].output = &dmxOutputs[i];
+        configs[i].pin = i;
+        configs[i].pio = i < 4 ? pio0 : pio1;
     }
-    for (int i = 4; i < 8; i++)
+
+    // All resources are checked before any output is started
+    if (dmxSystem.begin(configs, 8) != DmxSystem::SUCCESS)
     {
-        dmxOutputs[i].begin(i, pio1);
+        Serial.println("Could not start the DMX outputs!");
     }
 }
 
 void loop()
 {
-    // Send out universe on all 8 DMX outputs
-    for (int i = 0; i < 8; i++)
-    {
-        dmxOutputs[i].write(universe, UNIVERSE_LENGTH + 1);
-    }
-    for (int i = 0; i < 8; i++)
+    // Send out universe on all 8 DMX outputs at the same time
+    dmxSystem.group().write(universe, UNIVERSE_LENGTH + 1);
+
+    while (dmxSystem.group().busy())
     {
-        while (dmxOutputs[i].busy())
-        {
-            // Wait patiently until all outputs are done transmitting
-        }
+        // Wait patiently until all outputs are done transmitting
     }
 
     // delay a millisecond for stability (Not strictly necessary)
     delay(1);
-}
\ No newline at end of file
+}
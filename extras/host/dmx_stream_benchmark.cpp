@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Description:
+ * Loopback benchmark of the DmxUsbStream protocol. The reference client
+ * streams batches through a local pseudo terminal to a DmxUsbStream
+ * running in a second thread with mocked DMX outputs, and reports the
+ * number of universes per second
+ *
+ * Usage: dmx_stream_benchmark [batches] [ports]
+ */
+
+#include "DmxUsbStream.h"
+#include "MockDmxOutput.h"
+#include "dmx_stream_client.h"
+
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+static void device_loop(int fd, DmxUsbStream *stream, unsigned long num_batches)
+{
+    static uint8_t buffer[4096];
+
+    while (stream->batches() < num_batches)
+    {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0)
+            return;
+
+        // The mocked outputs are never busy, so the stream only stops
+        // after each completed batch, until its reply is taken
+        ssize_t consumed = 0;
+        while (consumed < n)
+        {
+            consumed += stream->feed(buffer + consumed, n - consumed);
+
+            uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+            if (stream->take_reply(reply))
+            {
+                if (write(fd, reply, sizeof(reply)) != sizeof(reply))
+                    return;
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long num_batches = argc > 1 ? atol(argv[1]) : 2000;
+    unsigned num_ports = argc > 2 ? atoi(argv[2]) : DMX_USB_STREAM_MAX_PORTS;
+    if (num_ports < 1 || num_ports > DMX_USB_STREAM_MAX_PORTS)
+    {
+        fprintf(stderr, "ports must be between 1 and %d\n", DMX_USB_STREAM_MAX_PORTS);
+        return 2;
+    }
+
+    // Open a pseudo terminal pair. The client talks to the master side,
+    // and the device reads the slave side in raw mode like a CDC port
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        perror("posix_openpt");
+        return 1;
+    }
+    int slave = dmx_stream_open_serial(ptsname(master));
+    if (slave < 0)
+    {
+        perror("ptsname");
+        return 1;
+    }
+
+    struct termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+
+    static DmxOutput outputs[DMX_USB_STREAM_MAX_PORTS];
+    static uint8_t device_frames[DMX_USB_STREAM_MAX_PORTS][DMX_UNIVERSE_SIZE + 1];
+    static uint8_t host_frames[DMX_USB_STREAM_MAX_PORTS][DMX_UNIVERSE_SIZE + 1];
+
+    DmxUsbStream stream;
+    DmxStreamRecord records[DMX_USB_STREAM_MAX_PORTS];
+    for (unsigned port = 0; port < num_ports; port++)
+    {
+        outputs[port].begin(port);
+        stream.attach(port, &outputs[port], device_frames[port]);
+
+        records[port].port = port;
+        records[port].frame = host_frames[port];
+        records[port].length = DMX_UNIVERSE_SIZE + 1;
+    }
+
+    std::thread device(device_loop, slave, &stream, num_batches);
+
+    DmxStreamClient client(master);
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned long batch = 0; batch < num_batches; batch++)
+    {
+        for (unsigned port = 0; port < num_ports; port++)
+        {
+            host_frames[port][1 + port] = batch;
+        }
+        if (!client.send(records, num_ports))
+        {
+            perror("send");
+            return 1;
+        }
+    }
+    if (!client.flush())
+    {
+        perror("flush");
+        return 1;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    device.join();
+
+    int result = 0;
+    if (client.acks() != num_batches || client.naks() != 0)
+    {
+        fprintf(stderr, "expected %lu ACK, got %lu ACK and %lu NAK\n", num_batches, client.acks(), client.naks());
+        result = 1;
+    }
+    for (unsigned port = 0; port < num_ports; port++)
+    {
+        if (mock_dmx_output(&outputs[port]).writes != num_batches ||
+            device_frames[port][1 + port] != host_frames[port][1 + port])
+        {
+            fprintf(stderr, "port %u did not receive all universes\n", port);
+            result = 1;
+        }
+    }
+
+    printf("%lu batches of %u universes in %.3f s\n", num_batches, num_ports, elapsed);
+    printf("%.1f universes/s\n", num_batches * num_ports / elapsed);
+
+    close(slave);
+    close(master);
+    return result;
+}
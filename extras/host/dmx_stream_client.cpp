@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "dmx_stream_client.h"
+#include "DmxUsbStream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+size_t dmx_stream_encode_batch(std::vector<uint8_t> &out, uint8_t sequence,
+                               const DmxStreamRecord *records, size_t num_records)
+{
+    size_t start = out.size();
+
+    out.push_back(DMX_USB_STREAM_MAGIC_0);
+    out.push_back(DMX_USB_STREAM_MAGIC_1);
+    out.push_back((uint8_t)num_records);
+    out.push_back(sequence);
+
+    for (size_t i = 0; i < num_records; i++)
+    {
+        out.push_back(records[i].port);
+        out.push_back(records[i].length & 0xff);
+        out.push_back(records[i].length >> 8);
+        out.insert(out.end(), records[i].frame, records[i].frame + records[i].length);
+    }
+
+    return out.size() - start;
+}
+
+int dmx_stream_open_serial(const char *path)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+        return -1;
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+DmxStreamClient::DmxStreamClient(int fd, unsigned window)
+    : _fd(fd), _window(window == 0 ? 1 : window)
+{
+}
+
+bool DmxStreamClient::_read_reply()
+{
+    uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+    size_t received = 0;
+
+    while (received < sizeof(reply))
+    {
+        ssize_t n = read(_fd, reply + received, sizeof(reply) - received);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        received += n;
+    }
+
+    if (reply[0] == DMX_USB_STREAM_ACK)
+        _acks++;
+    else
+        _naks++;
+    _in_flight--;
+
+    return true;
+}
+
+bool DmxStreamClient::send(const DmxStreamRecord *records, size_t num_records)
+{
+    while (_in_flight >= _window)
+    {
+        if (!_read_reply())
+            return false;
+    }
+
+    _buffer.clear();
+    dmx_stream_encode_batch(_buffer, _sequence++, records, num_records);
+
+    size_t sent = 0;
+    while (sent < _buffer.size())
+    {
+        ssize_t n = write(_fd, _buffer.data() + sent, _buffer.size() - sent);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        sent += n;
+    }
+    _in_flight++;
+
+    return true;
+}
+
+bool DmxStreamClient::flush()
+{
+    while (_in_flight > 0)
+    {
+        if (!_read_reply())
+            return false;
+    }
+
+    return true;
+}
+
+unsigned long DmxStreamClient::acks()
+{
+    return _acks;
+}
+
+unsigned long DmxStreamClient::naks()
+{
+    return _naks;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Reference host client for the DmxUsbStream protocol
+ */
+
+#ifndef DMX_STREAM_CLIENT_H
+#define DMX_STREAM_CLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/*
+    A single universe in a batch
+*/
+struct DmxStreamRecord
+{
+    // The port number the universe is sent to on the Pico
+    uint8_t port;
+
+    // The DMX frame, starting with the start code
+    const uint8_t *frame;
+
+    // The number of bytes of the frame to send, at most 513
+    uint16_t length;
+};
+
+/*
+    Encodes a batch of records into the wire format of the stream.
+    Returns the number of bytes appended to out
+*/
+size_t dmx_stream_encode_batch(std::vector<uint8_t> &out, uint8_t sequence,
+                               const DmxStreamRecord *records, size_t num_records);
+
+/*
+    Opens a serial device, such as /dev/ttyACM0, in raw mode.
+    Returns the file descriptor, or -1 on failure
+*/
+int dmx_stream_open_serial(const char *path);
+
+class DmxStreamClient
+{
+    int _fd;
+    unsigned _window;
+    unsigned _in_flight = 0;
+    uint8_t _sequence = 0;
+    unsigned long _acks = 0;
+    unsigned long _naks = 0;
+    std::vector<uint8_t> _buffer;
+
+    bool _read_reply();
+
+public:
+    /*
+        Param: fd
+        A file descriptor connected to the Pico, for example from
+        dmx_stream_open_serial(...)
+
+        Param: window
+        The number of batches that may be sent before their reply
+        has been received. The Pico throttles the stream while its
+        outputs are busy, so a small window keeps latency low
+    */
+    DmxStreamClient(int fd, unsigned window = 4);
+
+    /*
+        Sends one batch. Blocks while the window is full.
+        Returns false on I/O errors
+    */
+    bool send(const DmxStreamRecord *records, size_t num_records);
+
+    /*
+        Waits for the replies to all batches in flight.
+        Returns false on I/O errors
+    */
+    bool flush();
+
+    /*
+        Get the number of batches acknowledged with ACK and NAK
+    */
+    unsigned long acks();
+    unsigned long naks();
+};
+
+#endif
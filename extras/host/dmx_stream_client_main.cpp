@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Description:
+ * Streams a chase pattern to a Pico running DmxUsbStream and
+ * reports the number of universes per second the Pico accepts
+ *
+ * Usage: dmx_stream_client <serial device> [ports] [seconds]
+ */
+
+#include "dmx_stream_client.h"
+#include "DmxUsbStream.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <serial device> [ports] [seconds]\n", argv[0]);
+        return 2;
+    }
+
+    unsigned num_ports = argc > 2 ? atoi(argv[2]) : 1;
+    double seconds = argc > 3 ? atof(argv[3]) : 10.0;
+    if (num_ports < 1 || num_ports > DMX_USB_STREAM_MAX_PORTS)
+    {
+        fprintf(stderr, "ports must be between 1 and %d\n", DMX_USB_STREAM_MAX_PORTS);
+        return 2;
+    }
+
+    int fd = dmx_stream_open_serial(argv[1]);
+    if (fd < 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    static uint8_t frames[DMX_USB_STREAM_MAX_PORTS][DMX_UNIVERSE_SIZE + 1];
+    DmxStreamRecord records[DMX_USB_STREAM_MAX_PORTS];
+    for (unsigned port = 0; port < num_ports; port++)
+    {
+        records[port].port = port;
+        records[port].frame = frames[port];
+        records[port].length = DMX_UNIVERSE_SIZE + 1;
+    }
+
+    DmxStreamClient client(fd);
+    unsigned long batches = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+
+    while (elapsed < seconds)
+    {
+        // Chase a single full channel through each universe
+        for (unsigned port = 0; port < num_ports; port++)
+        {
+            frames[port][1 + (batches + DMX_UNIVERSE_SIZE - 1) % DMX_UNIVERSE_SIZE] = 0;
+            frames[port][1 + batches % DMX_UNIVERSE_SIZE] = 255;
+        }
+
+        if (!client.send(records, num_ports))
+        {
+            perror("send");
+            return 1;
+        }
+        batches++;
+
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    if (!client.flush())
+    {
+        perror("flush");
+        return 1;
+    }
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%lu batches, %lu ACK, %lu NAK\n", batches, client.acks(), client.naks());
+    printf("%.1f universes/s\n", batches * num_ports / elapsed);
+
+    close(fd);
+    return client.naks() == 0 ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Host implementation of DmxOutput that records writes instead of
+ * driving a PIO state machine
+ */
+
+#include "MockDmxOutput.h"
+
+#include <map>
+#include <mutex>
+
+static std::map<DmxOutput *, MockDmxOutputState> mock_states;
+static std::mutex mock_states_lock;
+
+MockDmxOutputState &mock_dmx_output(DmxOutput *output)
+{
+    std::lock_guard<std::mutex> lock(mock_states_lock);
+    return mock_states[output];
+}
+
+void mock_dmx_output_reset()
+{
+    std::lock_guard<std::mutex> lock(mock_states_lock);
+    mock_states.clear();
+}
+
+DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
+{
+    _pin = pin;
+    _pio = pio;
+    mock_dmx_output(this);
+    return SUCCESS;
+}
+
+void DmxOutput::write(uint8_t *universe, uint length)
+{
+    MockDmxOutputState &state = mock_dmx_output(this);
+    state.writes++;
+    state.universe = universe;
+    state.length = length;
+}
+
+bool DmxOutput::busy()
+{
+    return mock_dmx_output(this).busy;
+}
+
+void DmxOutput::end()
+{
+}
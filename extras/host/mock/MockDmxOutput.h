@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef MOCK_DMX_OUTPUT_H
+#define MOCK_DMX_OUTPUT_H
+
+#include "DmxOutput.h"
+
+/*
+    The state of a mocked DMX output, as seen and controlled by host tests
+*/
+struct MockDmxOutputState
+{
+    // Set to make busy() report an ongoing transmission
+    bool busy = false;
+
+    // The number of calls to write()
+    uint writes = 0;
+
+    // The arguments of the latest call to write()
+    const uint8_t *universe = nullptr;
+    uint length = 0;
+};
+
+/*
+    Get the mock state of a DMX output. The state is created on first use
+*/
+MockDmxOutputState &mock_dmx_output(DmxOutput *output);
+
+/*
+    Forget the state of all mocked DMX outputs
+*/
+void mock_dmx_output_reset();
+
+#endif
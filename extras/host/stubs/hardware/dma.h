@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Minimal stand-in for the pico-sdk DMA header, so the hardware
+ * independent parts of the library can be built on a host
+ */
+
+#ifndef HOST_STUB_HARDWARE_DMA_H
+#define HOST_STUB_HARDWARE_DMA_H
+
+#include "hardware/pio.h"
+
+#endif
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Minimal stand-in for the pico-sdk PIO header, so the hardware
+ * independent parts of the library can be built on a host
+ */
+
+#ifndef HOST_STUB_HARDWARE_PIO_H
+#define HOST_STUB_HARDWARE_PIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t *PIO;
+
+#define pio0 ((PIO)0)
+#define pio1 ((PIO)1)
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Minimal stand-in for the pico-sdk PWM header, so the hardware
+ * independent parts of the library can be built on a host
+ */
+
+#ifndef HOST_STUB_HARDWARE_PWM_H
+#define HOST_STUB_HARDWARE_PWM_H
+
+#include "hardware/timer.h"
+
+static inline void pwm_set_gpio_level(uint gpio, uint16_t level)
+{
+    (void)gpio;
+    (void)level;
+}
+
+#endif
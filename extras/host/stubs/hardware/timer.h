@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Minimal stand-in for the pico-sdk timer header, so the hardware
+ * independent parts of the library can be built on a host. Alarms
+ * never fire; host tests drive the code directly
+ */
+
+#ifndef HOST_STUB_HARDWARE_TIMER_H
+#define HOST_STUB_HARDWARE_TIMER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+typedef void (*hardware_alarm_callback_t)(uint alarm_num);
+
+static uint host_stub_claimed_alarms = 0;
+
+static inline absolute_time_t from_us_since_boot(uint64_t us)
+{
+    return us;
+}
+
+static inline uint64_t time_us_64()
+{
+    return 0;
+}
+
+static inline int hardware_alarm_claim_unused(bool required)
+{
+    (void)required;
+    for (uint alarm = 0; alarm < 4; alarm++)
+    {
+        if (!(host_stub_claimed_alarms & (1u << alarm)))
+        {
+            host_stub_claimed_alarms |= 1u << alarm;
+            return alarm;
+        }
+    }
+    return -1;
+}
+
+static inline void hardware_alarm_unclaim(uint alarm_num)
+{
+    host_stub_claimed_alarms &= ~(1u << alarm_num);
+}
+
+static inline void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback)
+{
+    (void)alarm_num;
+    (void)callback;
+}
+
+static inline bool hardware_alarm_set_target(uint alarm_num, absolute_time_t target)
+{
+    (void)alarm_num;
+    (void)target;
+    return false;
+}
+
+static inline void hardware_alarm_cancel(uint alarm_num)
+{
+    (void)alarm_num;
+}
+
+#endif
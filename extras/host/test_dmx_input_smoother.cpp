@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Host tests of the DmxInputSmoother filter response. The tests call
+ * update() directly, one call per tick of the hardware alarm
+ */
+
+#include "DmxInputSmoother.h"
+#include "test_check.h"
+
+// Runs a step from 0 to 255 on one channel, and returns the tick at which
+// the output first reaches full scale. The output must never move backwards
+static uint step_response(DmxInputSmoother::mode smoothing, uint time_ms, uint rate_hz,
+                          uint16_t *response, uint max_ticks)
+{
+    volatile uint8_t input[2] = {0, 0};
+    volatile uint16_t output[1];
+
+    DmxInputSmoother smoother;
+    CHECK(smoother.add_channel(1, smoothing, time_ms) == DmxInputSmoother::SUCCESS);
+    CHECK(smoother.begin(input, output, rate_hz) == DmxInputSmoother::SUCCESS);
+    CHECK(output[0] == 0);
+
+    input[1] = 255;
+
+    uint reached = 0;
+    uint16_t previous = 0;
+    for (uint tick = 1; tick <= max_ticks; tick++)
+    {
+        smoother.update();
+        CHECK(output[0] >= previous);
+        CHECK(output[0] <= DMX_SMOOTHER_FULL_SCALE);
+        previous = output[0];
+        if (response != nullptr)
+            response[tick] = output[0];
+        if (reached == 0 && output[0] == DMX_SMOOTHER_FULL_SCALE)
+            reached = tick;
+    }
+
+    smoother.end();
+    return reached;
+}
+
+static void test_slew_reaches_full_scale_after_time()
+{
+    // 500ms at 1kHz is 500 ticks, not one tick less
+    CHECK(step_response(DmxInputSmoother::MODE_SLEW, 500, 1000, nullptr, 600) == 500);
+    CHECK(step_response(DmxInputSmoother::MODE_SLEW, 23, 1000, nullptr, 100) == 23);
+    CHECK(step_response(DmxInputSmoother::MODE_SLEW, 100, 44, nullptr, 10) == 4);
+
+    // 50s at 100kHz overflows 32 bits, and is clamped to the longest ramp
+    CHECK(step_response(DmxInputSmoother::MODE_SLEW, 50000, 100000, nullptr, 70000) == UINT16_MAX);
+}
+
+static void test_slew_speed_is_even()
+{
+    static uint16_t response[601];
+    step_response(DmxInputSmoother::MODE_SLEW, 500, 1000, response, 600);
+
+    // 0xFF00 / 500 is 130.56, so every step is 130 or 131
+    for (uint tick = 1; tick <= 500; tick++)
+    {
+        uint16_t step = response[tick] - response[tick - 1];
+        CHECK(step == 130 || step == 131);
+    }
+}
+
+static void test_linear_ramp()
+{
+    static uint16_t response[101];
+    CHECK(step_response(DmxInputSmoother::MODE_LINEAR, 20, 1000, response, 100) == 20);
+
+    // Halfway through the ramp, the output is halfway
+    CHECK(response[10] == DMX_SMOOTHER_FULL_SCALE / 2);
+    CHECK(response[19] < DMX_SMOOTHER_FULL_SCALE);
+}
+
+static void test_cubic_ramp()
+{
+    static uint16_t linear[101];
+    static uint16_t cubic[101];
+    step_response(DmxInputSmoother::MODE_LINEAR, 20, 1000, linear, 100);
+    CHECK(step_response(DmxInputSmoother::MODE_CUBIC, 20, 1000, cubic, 100) == 20);
+
+    // The S-curve is symmetric, starts slower and ends slower than a linear ramp
+    CHECK(cubic[10] == DMX_SMOOTHER_FULL_SCALE / 2);
+    CHECK(cubic[1] < linear[1]);
+    CHECK(cubic[19] > linear[19]);
+    CHECK(cubic[1] - cubic[0] < cubic[11] - cubic[10]);
+}
+
+static void test_ramp_down_and_retarget()
+{
+    volatile uint8_t input[2] = {0, 200};
+    volatile uint16_t output[1];
+
+    DmxInputSmoother smoother;
+    smoother.add_channel(1, DmxInputSmoother::MODE_LINEAR, 10);
+    smoother.begin(input, output, 1000);
+    CHECK(output[0] == 200 << 8);
+
+    // Ramp down halfway, then retarget from wherever the output is
+    input[1] = 0;
+    for (uint tick = 0; tick < 5; tick++)
+        smoother.update();
+    CHECK(output[0] == 100 << 8);
+
+    input[1] = 150;
+    uint16_t previous = output[0];
+    for (uint tick = 0; tick < 10; tick++)
+    {
+        smoother.update();
+        CHECK(output[0] >= previous);
+        previous = output[0];
+    }
+    CHECK(output[0] == 150 << 8);
+
+    smoother.end();
+}
+
+static void test_begin_validation()
+{
+    volatile uint8_t input[2] = {0, 0};
+    volatile uint16_t output[1];
+
+    DmxInputSmoother smoother;
+    smoother.add_channel(1, DmxInputSmoother::MODE_SLEW, 10);
+    CHECK(smoother.begin(input, output, 0) == DmxInputSmoother::ERR_INVALID_RATE);
+    CHECK(smoother.begin(input, output, DMX_SMOOTHER_MAX_RATE + 1) == DmxInputSmoother::ERR_INVALID_RATE);
+    CHECK(smoother.begin(input, output, DMX_SMOOTHER_MAX_RATE) == DmxInputSmoother::SUCCESS);
+    CHECK(smoother.begin(input, output, 1000) == DmxInputSmoother::ERR_ALREADY_STARTED);
+    CHECK(smoother.add_channel(1, DmxInputSmoother::MODE_SLEW, 10) == DmxInputSmoother::ERR_ALREADY_STARTED);
+    smoother.end();
+    CHECK(smoother.begin(input, output, 1000) == DmxInputSmoother::SUCCESS);
+    smoother.end();
+
+    DmxInputSmoother full;
+    for (uint i = 0; i < DMX_SMOOTHER_MAX_CHANNELS; i++)
+        CHECK(full.add_channel(1, DmxInputSmoother::MODE_SLEW, 10) == DmxInputSmoother::SUCCESS);
+    CHECK(full.add_channel(1, DmxInputSmoother::MODE_SLEW, 10) == DmxInputSmoother::ERR_TOO_MANY_CHANNELS);
+}
+
+int main()
+{
+    test_slew_reaches_full_scale_after_time();
+    test_slew_speed_is_even();
+    test_linear_ramp();
+    test_cubic_ramp();
+    test_ramp_down_and_retarget();
+    test_begin_validation();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Host tests for the DmxUsbStream parser
+ */
+
+#include "DmxUsbStream.h"
+#include "MockDmxOutput.h"
+#include "dmx_stream_client.h"
+#include "test_check.h"
+
+#include <string.h>
+
+static uint8_t frame_a[DMX_UNIVERSE_SIZE + 1];
+static uint8_t frame_b[DMX_UNIVERSE_SIZE + 1];
+
+static std::vector<uint8_t> make_batch(uint8_t sequence, uint8_t port_a, uint16_t length_a,
+                                       uint8_t port_b, uint16_t length_b, uint8_t fill)
+{
+    static uint8_t payload[DMX_UNIVERSE_SIZE + 1];
+    memset(payload, fill, sizeof(payload));
+    payload[0] = 0;
+
+    DmxStreamRecord records[] = {
+        {port_a, payload, length_a},
+        {port_b, payload, length_b},
+    };
+    std::vector<uint8_t> batch;
+    dmx_stream_encode_batch(batch, sequence, records, 2);
+    return batch;
+}
+
+static void test_batch_written_in_any_chunking()
+{
+    for (size_t chunk = 1; chunk <= 600; chunk += 97)
+    {
+        mock_dmx_output_reset();
+        DmxOutput out_a, out_b;
+        DmxUsbStream stream;
+        stream.attach(0, &out_a, frame_a);
+        stream.attach(1, &out_b, frame_b);
+
+        std::vector<uint8_t> batch = make_batch(42, 0, 513, 1, 4, 0x55);
+        for (size_t pos = 0; pos < batch.size(); pos += chunk)
+        {
+            size_t length = batch.size() - pos < chunk ? batch.size() - pos : chunk;
+            CHECK(stream.feed(batch.data() + pos, length) == length);
+        }
+
+        uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+        CHECK(stream.take_reply(reply));
+        CHECK(reply[0] == DMX_USB_STREAM_ACK);
+        CHECK(reply[1] == 42);
+        CHECK(!stream.take_reply(reply));
+
+        CHECK(mock_dmx_output(&out_a).writes == 1);
+        CHECK(mock_dmx_output(&out_a).universe == frame_a);
+        CHECK(mock_dmx_output(&out_a).length == 513);
+        CHECK(mock_dmx_output(&out_b).writes == 1);
+        CHECK(mock_dmx_output(&out_b).length == 4);
+        CHECK(frame_a[0] == 0 && frame_a[1] == 0x55 && frame_a[512] == 0x55);
+        CHECK(stream.batches() == 1);
+        CHECK(stream.errors() == 0);
+    }
+}
+
+static void test_resync_after_garbage()
+{
+    mock_dmx_output_reset();
+    DmxOutput out_a, out_b;
+    DmxUsbStream stream;
+    stream.attach(0, &out_a, frame_a);
+    stream.attach(1, &out_b, frame_b);
+
+    // Garbage with false starts of a batch header
+    std::vector<uint8_t> data = {0x00, 'D', 0x13, 'D', 'D', 0xff, 'X'};
+    std::vector<uint8_t> batch = make_batch(7, 0, 10, 1, 10, 0x11);
+    data.insert(data.end(), batch.begin(), batch.end());
+
+    CHECK(stream.feed(data.data(), data.size()) == data.size());
+
+    uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+    CHECK(stream.take_reply(reply));
+    CHECK(reply[0] == DMX_USB_STREAM_ACK);
+    CHECK(reply[1] == 7);
+    CHECK(mock_dmx_output(&out_a).writes == 1);
+    CHECK(mock_dmx_output(&out_b).writes == 1);
+    CHECK(stream.errors() > 0);
+}
+
+static void test_nak_on_unknown_port()
+{
+    mock_dmx_output_reset();
+    DmxOutput out_a;
+    DmxUsbStream stream;
+    stream.attach(0, &out_a, frame_a);
+
+    // Port 5 is not attached. Its payload is skipped, port 0 is still written
+    std::vector<uint8_t> batch = make_batch(3, 5, 100, 0, 20, 0x22);
+    CHECK(stream.feed(batch.data(), batch.size()) == batch.size());
+
+    uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+    CHECK(stream.take_reply(reply));
+    CHECK(reply[0] == DMX_USB_STREAM_NAK);
+    CHECK(reply[1] == 3);
+    CHECK(mock_dmx_output(&out_a).writes == 1);
+    CHECK(mock_dmx_output(&out_a).length == 20);
+    CHECK(stream.errors() == 1);
+
+    // A too long record is rejected the same way
+    batch = make_batch(4, 0, 514, 0, 20, 0x22);
+    CHECK(stream.feed(batch.data(), batch.size()) == batch.size());
+    CHECK(stream.take_reply(reply));
+    CHECK(reply[0] == DMX_USB_STREAM_NAK);
+    CHECK(reply[1] == 4);
+}
+
+static void test_back_pressure_stall()
+{
+    mock_dmx_output_reset();
+    DmxOutput out_a, out_b;
+    DmxUsbStream stream;
+    stream.attach(0, &out_a, frame_a);
+    stream.attach(1, &out_b, frame_b);
+    memset(frame_a, 0, sizeof(frame_a));
+
+    mock_dmx_output(&out_a).busy = true;
+
+    // The stream stops right before the payload of the busy output
+    std::vector<uint8_t> batch = make_batch(9, 0, 513, 1, 513, 0x33);
+    size_t consumed = stream.feed(batch.data(), batch.size());
+    CHECK(consumed == DMX_USB_STREAM_BATCH_HEADER_SIZE + DMX_USB_STREAM_RECORD_HEADER_SIZE);
+    CHECK(frame_a[1] == 0);
+    CHECK(stream.feed(batch.data() + consumed, batch.size() - consumed) == 0);
+
+    uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+    CHECK(!stream.take_reply(reply));
+
+    mock_dmx_output(&out_a).busy = false;
+    CHECK(stream.feed(batch.data() + consumed, batch.size() - consumed) == batch.size() - consumed);
+    CHECK(stream.take_reply(reply));
+    CHECK(reply[0] == DMX_USB_STREAM_ACK);
+    CHECK(frame_a[1] == 0x33);
+    CHECK(mock_dmx_output(&out_a).writes == 1);
+    CHECK(mock_dmx_output(&out_b).writes == 1);
+}
+
+static void test_two_batches_in_one_feed()
+{
+    mock_dmx_output_reset();
+    DmxOutput out_a, out_b;
+    DmxUsbStream stream;
+    stream.attach(0, &out_a, frame_a);
+    stream.attach(1, &out_b, frame_b);
+
+    std::vector<uint8_t> data = make_batch(1, 0, 10, 1, 10, 0x66);
+    size_t first_length = data.size();
+    std::vector<uint8_t> second = make_batch(2, 0, 10, 1, 10, 0x77);
+    data.insert(data.end(), second.begin(), second.end());
+
+    // The stream stops after the first batch until its reply is taken
+    CHECK(stream.feed(data.data(), data.size()) == first_length);
+    CHECK(stream.feed(data.data() + first_length, data.size() - first_length) == 0);
+
+    uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+    CHECK(stream.take_reply(reply));
+    CHECK(reply[0] == DMX_USB_STREAM_ACK);
+    CHECK(reply[1] == 1);
+
+    CHECK(stream.feed(data.data() + first_length, data.size() - first_length) == data.size() - first_length);
+    CHECK(stream.take_reply(reply));
+    CHECK(reply[0] == DMX_USB_STREAM_ACK);
+    CHECK(reply[1] == 2);
+    CHECK(!stream.take_reply(reply));
+
+    CHECK(stream.batches() == 2);
+    CHECK(mock_dmx_output(&out_a).writes == 2);
+    CHECK(frame_a[1] == 0x77);
+}
+
+static void test_attach_and_reset()
+{
+    mock_dmx_output_reset();
+    DmxOutput out_a;
+    DmxUsbStream stream;
+    CHECK(stream.attach(DMX_USB_STREAM_MAX_PORTS, &out_a, frame_a) == DmxUsbStream::ERR_INVALID_PORT);
+    CHECK(stream.attach(0, &out_a, nullptr) == DmxUsbStream::ERR_INVALID_FRAME);
+    CHECK(stream.attach(0, nullptr, nullptr) == DmxUsbStream::SUCCESS);
+    CHECK(stream.attach(0, &out_a, frame_a) == DmxUsbStream::SUCCESS);
+
+    // A partial batch is dropped by reset()
+    std::vector<uint8_t> batch = make_batch(1, 0, 50, 0, 50, 0x44);
+    stream.feed(batch.data(), 30);
+    stream.reset();
+    batch = make_batch(2, 0, 50, 0, 50, 0x44);
+    CHECK(stream.feed(batch.data(), batch.size()) == batch.size());
+
+    uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+    CHECK(stream.take_reply(reply));
+    CHECK(reply[0] == DMX_USB_STREAM_ACK);
+    CHECK(reply[1] == 2);
+    CHECK(stream.batches() == 1);
+}
+
+int main()
+{
+    test_batch_written_in_any_chunking();
+    test_resync_after_garbage();
+    test_nak_on_unknown_port();
+    test_back_pressure_stall();
+    test_two_batches_in_one_feed();
+    test_attach_and_reset();
+
+    return TEST_RESULT();
+}
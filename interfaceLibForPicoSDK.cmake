@@ -8,7 +8,11 @@ add_library(picodmx INTERFACE)
 
 target_sources(picodmx INTERFACE
     ${CMAKE_CURRENT_LIST_DIR}/src/DmxInput.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/DmxInputSmoother.cpp
     ${CMAKE_CURRENT_LIST_DIR}/src/DmxOutput.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/DmxOutputGroup.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/DmxSystem.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/src/DmxUsbStream.cpp
 )
 
 pico_generate_pio_header(picodmx
@@ -18,6 +22,10 @@ pico_generate_pio_header(picodmx
     ${CMAKE_CURRENT_LIST_DIR}/extras/DmxOutput.pio
 )
 
+target_link_libraries(picodmx INTERFACE
+    hardware_pwm
+)
+
 target_include_directories(picodmx INTERFACE
     ${CMAKE_CURRENT_LIST_DIR}/src
 )
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "DmxInputSmoother.h"
+
+#if defined(ARDUINO_ARCH_MBED)
+  #include <pwm.h>
+#else
+  #include "hardware/pwm.h"
+#endif
+
+/*
+This array tells the alarm handler which smoother the alarm belongs to.
+The handler only gets the alarm number, so this array needs as many spots as there are hardware alarms.
+*/
+#define DMX_SMOOTHER_NUM_ALARMS 4
+DmxInputSmoother *active_smoothers[DMX_SMOOTHER_NUM_ALARMS] = {nullptr};
+
+// Ramp position in 1.15 fixed point, from 0 to 1
+#define RAMP_ONE (1u << 15)
+
+static void dmxinputsmoother_schedule(uint alarm, DmxInputSmoother *instance)
+{
+    // If we have fallen behind, skip ticks instead of firing in a burst
+    do
+    {
+        instance->_next_tick_us += instance->_period_us;
+    } while (hardware_alarm_set_target(alarm, from_us_since_boot(instance->_next_tick_us)));
+}
+
+void dmxinputsmoother_alarm_handler(uint alarm)
+{
+    DmxInputSmoother *instance = active_smoothers[alarm];
+    if (instance == nullptr)
+        return;
+
+    instance->update();
+    dmxinputsmoother_schedule(alarm, instance);
+}
+
+DmxInputSmoother::return_code DmxInputSmoother::add_channel(uint index, mode smoothing, uint time_ms, int pwm_pin)
+{
+    // Channels are only initialised by .begin(...)
+    if (_running)
+    {
+        return ERR_ALREADY_STARTED;
+    }
+
+    if (_num_channels >= DMX_SMOOTHER_MAX_CHANNELS)
+    {
+        return ERR_TOO_MANY_CHANNELS;
+    }
+
+    channel *ch = &_channels[_num_channels];
+    ch->index = index;
+    ch->smoothing = smoothing;
+    ch->time_ms = time_ms;
+    ch->pwm_pin = pwm_pin;
+
+    _num_channels++;
+
+    return SUCCESS;
+}
+
+DmxInputSmoother::return_code DmxInputSmoother::begin(volatile uint8_t *input, volatile uint16_t *output, uint rate_hz)
+{
+    if (_running)
+    {
+        return ERR_ALREADY_STARTED;
+    }
+
+    if (rate_hz == 0 || rate_hz > DMX_SMOOTHER_MAX_RATE)
+    {
+        return ERR_INVALID_RATE;
+    }
+
+    int alarm = hardware_alarm_claim_unused(false);
+    if (alarm == -1)
+    {
+        return ERR_NO_TIMER_AVAILABLE;
+    }
+
+    _input = input;
+    _output = output;
+    _period_us = 1000000 / rate_hz;
+    _alarm = alarm;
+    _running = true;
+
+    // Convert the channel timings to ticks, and start each channel
+    // at the value currently in the input buffer
+    for (uint i = 0; i < _num_channels; i++)
+    {
+        channel *ch = &_channels[i];
+
+        uint64_t ticks = (uint64_t)ch->time_ms * rate_hz / 1000;
+        if (ticks == 0)
+            ticks = 1;
+        if (ticks > UINT16_MAX)
+            ticks = UINT16_MAX;
+
+        // A full-scale slew moves step units per tick, plus one extra unit
+        // on step_remainder out of every ramp_ticks ticks. This spreads the
+        // remainder evenly, so it ends exactly after ramp_ticks ticks
+        ch->ramp_ticks = ticks;
+        ch->step = DMX_SMOOTHER_FULL_SCALE / ticks;
+        ch->step_remainder = DMX_SMOOTHER_FULL_SCALE % ticks;
+        ch->slew_error = 0;
+
+        ch->target = input[ch->index] << 8;
+        ch->start = ch->target;
+        ch->value = ch->target;
+        ch->tick = ch->ramp_ticks;
+
+        _output[i] = ch->value;
+    }
+
+    active_smoothers[_alarm] = this;
+    hardware_alarm_set_callback(_alarm, dmxinputsmoother_alarm_handler);
+
+    _next_tick_us = time_us_64();
+    dmxinputsmoother_schedule(_alarm, this);
+
+    return SUCCESS;
+}
+
+void DmxInputSmoother::update()
+{
+    for (uint i = 0; i < _num_channels; i++)
+    {
+        channel *ch = &_channels[i];
+
+        // A new value has been received. Start a new ramp from where we are now
+        uint16_t target = _input[ch->index] << 8;
+        if (target != ch->target)
+        {
+            ch->start = ch->value;
+            ch->target = target;
+            ch->tick = 0;
+            ch->slew_error = 0;
+        }
+
+        if (ch->smoothing == MODE_SLEW)
+        {
+            uint32_t step = ch->step;
+            ch->slew_error += ch->step_remainder;
+            if (ch->slew_error >= ch->ramp_ticks)
+            {
+                ch->slew_error -= ch->ramp_ticks;
+                step++;
+            }
+
+            if (ch->value + step <= ch->target)
+                ch->value += step;
+            else if (ch->value >= ch->target + step)
+                ch->value -= step;
+            else
+                ch->value = ch->target;
+        }
+        else if (ch->tick < ch->ramp_ticks)
+        {
+            ch->tick++;
+
+            uint32_t t = ((uint32_t)ch->tick << 15) / ch->ramp_ticks;
+            if (ch->smoothing == MODE_CUBIC)
+            {
+                // Smoothstep, 3t^2 - 2t^3
+                uint32_t t2 = (t * t) >> 15;
+                t = (t2 * (3 * RAMP_ONE - 2 * t)) >> 15;
+            }
+
+            int32_t delta = (int32_t)ch->target - (int32_t)ch->start;
+            ch->value = ch->start + ((delta * (int32_t)t) >> 15);
+        }
+
+        _output[i] = ch->value;
+        if (ch->pwm_pin != DMX_SMOOTHER_NO_PWM)
+        {
+            pwm_set_gpio_level(ch->pwm_pin, ch->value);
+        }
+    }
+}
+
+void DmxInputSmoother::end()
+{
+    if (!_running)
+    {
+        return;
+    }
+
+    hardware_alarm_cancel(_alarm);
+    hardware_alarm_set_callback(_alarm, nullptr);
+    active_smoothers[_alarm] = nullptr;
+    hardware_alarm_unclaim(_alarm);
+
+    _running = false;
+}
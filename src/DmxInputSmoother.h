@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef DMX_INPUT_SMOOTHER_H
+#define DMX_INPUT_SMOOTHER_H
+
+#if defined(ARDUINO_ARCH_MBED)
+  #include <timer.h>
+#else
+  #ifdef ARDUINO
+    #include <Arduino.h>
+  #endif
+  #include "hardware/timer.h"
+#endif
+
+#define DMX_SMOOTHER_MAX_CHANNELS 16
+#define DMX_SMOOTHER_DEFAULT_RATE 1000
+
+// Keeps the alarm period at 10us or longer, so the alarm handler has time to run
+#define DMX_SMOOTHER_MAX_RATE 100000
+
+// Smoothed values are 8.8 fixed point, so channel value 255 becomes 0xFF00
+#define DMX_SMOOTHER_FULL_SCALE 0xFF00
+#define DMX_SMOOTHER_NO_PWM -1
+
+class DmxInputSmoother
+{
+public:
+    /*
+        The smoothing applied to a channel
+    */
+    enum mode
+    {
+        // Move towards the received value at a limited speed
+        MODE_SLEW,
+
+        // Ramp linearly from the current value to the received value
+        MODE_LINEAR,
+
+        // Ramp from the current value to the received value along an
+        // S-curve, starting and stopping with zero speed
+        MODE_CUBIC
+    };
+
+    /*
+        All different return codes for the DMX input smoother class.
+    */
+    enum return_code
+    {
+        SUCCESS = 0,
+
+        // All smoother channels are in use
+        ERR_TOO_MANY_CHANNELS = -1,
+
+        // There are no unused hardware alarms to run the smoother
+        ERR_NO_TIMER_AVAILABLE = -2,
+
+        // The rate is 0 or above DMX_SMOOTHER_MAX_RATE
+        ERR_INVALID_RATE = -3,
+
+        // The smoother is already running. Call .end() first, also
+        // before adding channels
+        ERR_ALREADY_STARTED = -4
+    };
+
+    struct channel
+    {
+        uint index;
+        mode smoothing;
+        uint time_ms;
+        int pwm_pin;
+        uint16_t step;
+        uint16_t step_remainder;
+        uint32_t slew_error;
+        uint16_t ramp_ticks;
+        uint16_t tick;
+        uint16_t start;
+        uint16_t target;
+        uint16_t value;
+    };
+
+    /*
+        private properties that are declared public so the timer handler has access
+    */
+    volatile uint8_t *_input;
+    volatile uint16_t *_output;
+    channel _channels[DMX_SMOOTHER_MAX_CHANNELS];
+    uint _num_channels = 0;
+    uint _period_us;
+    uint _alarm;
+    bool _running = false;
+    uint64_t _next_tick_us;
+
+    /*
+        Selects a channel of the DMX input buffer to smooth. Call this
+        before .begin(...). The smoothed value of the n'th added channel
+        is written to the n'th element of the output array. Channels
+        can't be added while the smoother is running.
+
+        Param: index
+        The index of the channel in the DMX input buffer. Index 0 is
+        the start code.
+
+        Param: smoothing
+        The smoothing to apply
+
+        Param: time_ms
+        For MODE_SLEW, the time a full-scale move from 0 to 255 takes,
+        rounded down to whole ticks.
+        For MODE_LINEAR and MODE_CUBIC, the length of each ramp. To
+        smooth out a 44 Hz DMX signal, use about 23ms
+
+        Param: pwm_pin
+        A GPIO pin with PWM already configured that should follow the
+        smoothed value. Set the PWM wrap to DMX_SMOOTHER_FULL_SCALE
+        to use the full range
+    */
+    return_code add_channel(uint index, mode smoothing, uint time_ms, int pwm_pin = DMX_SMOOTHER_NO_PWM);
+
+    /*
+        Starts smoothing the selected channels from a hardware alarm,
+        outside of the DMX input interrupt.
+
+        Param: input
+        The buffer given to DmxInput::read_async(...)
+
+        Param: output
+        An array with one 8.8 fixed point value per added channel
+
+        Param: rate_hz
+        The rate at which the smoothed values are updated, from 1 Hz
+        to DMX_SMOOTHER_MAX_RATE
+    */
+    return_code begin(volatile uint8_t *input, volatile uint16_t *output, uint rate_hz = DMX_SMOOTHER_DEFAULT_RATE);
+
+    /*
+        Advances all channels by one tick. Called from the hardware alarm
+    */
+    void update();
+
+    /*
+        Stops the smoother and releases the hardware alarm
+    */
+    void end();
+};
+
+#endif
@@ -18,16 +18,16 @@
 
 DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
 {
-    /* 
-    Attempt to load the DMX PIO assembly program 
-    into the PIO program memory
+    /*
+    Check that the DMX PIO assembly program fits in the
+    PIO program memory. It is loaded once all other resources
+    have been claimed
     */
 
     if (!pio_can_add_program(pio, &DmxOutput_program))
     {
         return ERR_INSUFFICIENT_PRGM_MEM;
     }
-    uint prgm_offset = pio_add_program(pio, &DmxOutput_program);
 
     /* 
     Attempt to claim an unused State Machine 
@@ -40,6 +40,27 @@ DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
         return ERR_NO_SM_AVAILABLE;
     }
 
+    // Claim an unused DMA channel.
+    // The channel is kept througout the lifetime of the DMX source
+    int dma = dma_claim_unused_channel(false);
+
+    if (dma == -1)
+    {
+        // Release the state machine so nothing is leaked
+        pio_sm_unclaim(pio, sm);
+        return ERR_NO_DMA_AVAILABLE;
+    }
+
+    uint prgm_offset = pio_add_program(pio, &DmxOutput_program);
+
+    _configure(pin, pio, sm, prgm_offset, dma);
+    _owns_prgm = true;
+
+    return SUCCESS;
+}
+
+void DmxOutput::_configure(uint pin, PIO pio, uint sm, uint prgm_offset, uint dma)
+{
     // Set this pin's GPIO function (connect PIO to the pad)
     pio_sm_set_pins_with_mask(pio, sm, 1u << pin, 1u << pin);
     pio_sm_set_pindirs_with_mask(pio, sm, 1u << pin, 1u << pin);
@@ -60,13 +81,6 @@ DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
     pio_sm_init(pio, sm, prgm_offset, &sm_conf);
     pio_sm_set_enabled(pio, sm, true);
 
-    // Claim an unused DMA channel.
-    // The channel is kept througout the lifetime of the DMX source
-    int dma = dma_claim_unused_channel(false);
-
-    if (dma == -1)
-        return ERR_NO_DMA_AVAILABLE;
-
     // Get the default DMA config for our claimed channel
     dma_channel_config dma_conf = dma_channel_get_default_config(dma);
 
@@ -89,8 +103,7 @@ DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
     _sm = sm;
     _pin = pin;
     _dma = dma;
-
-    return SUCCESS;
+    _active = true;
 }
 
 void DmxOutput::write(uint8_t *universe, uint length)
@@ -133,15 +146,31 @@ void Dmx::await()
 
 void DmxOutput::end()
 {
+    // The resources of an ended output may already belong to someone else
+    if (!_active)
+    {
+        return;
+    }
+
+    // Stop any ongoing transfer, so the DMA channel is idle
+    // before it is handed to someone else
+    dma_channel_abort(_dma);
+
     // Stop the PIO state machine
     pio_sm_set_enabled(_pio, _sm, false);
 
-    // Remove the PIO DMX program from the PIO program memory
-    pio_remove_program(_pio, &DmxOutput_program, _prgm_offset);
+    // Remove the PIO DMX program from the PIO program memory,
+    // unless it is shared with other outputs
+    if (_owns_prgm)
+    {
+        pio_remove_program(_pio, &DmxOutput_program, _prgm_offset);
+    }
 
     // Unclaim the DMA channel
     dma_channel_unclaim(_dma);
 
     // Unclaim the sm
     pio_sm_unclaim(_pio, _sm);
+
+    _active = false;
 }
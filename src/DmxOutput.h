@@ -23,11 +23,25 @@
 
 class DmxOutput
 {
+    // The output group arms and starts the state machine and DMA
+    // channel of each of its outputs directly
+    friend class DmxOutputGroup;
+
+    // The DMX system claims resources for many outputs at once
+    // and shares one copy of the PIO program between them
+    friend class DmxSystem;
+
     uint _prgm_offset;
     uint _pin;
     uint _sm;
     PIO _pio;
     uint _dma;
+    bool _owns_prgm = false;
+    bool _active = false;
+
+    // Configures the GPIO, state machine and DMA channel of an
+    // instance that has already claimed all its resources
+    void _configure(uint pin, PIO pio, uint sm, uint prgm_offset, uint dma);
 
 public:
     /*
@@ -103,7 +117,8 @@ public:
     /*
         De-inits the DMX transmitter instance. Releases PIO 
         and DMA resources. The instance can safely be destroyed
-        after this method is called
+        after this method is called. Calling it on an instance
+        that is not running does nothing
     */
     void end();
 };
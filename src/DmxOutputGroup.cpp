@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "DmxOutputGroup.h"
+
+#if defined(ARDUINO_ARCH_MBED)
+  #include <Arduino.h>
+  #include <sync.h>
+  // The mbed core exposes SysTick through CMSIS
+  #define SYSTICK_CSR SysTick->CTRL
+  #define SYSTICK_RVR SysTick->LOAD
+  #define SYSTICK_CVR SysTick->VAL
+#else
+  #include "hardware/structs/systick.h"
+  #include "hardware/sync.h"
+  #define SYSTICK_CSR systick_hw->csr
+  #define SYSTICK_RVR systick_hw->rvr
+  #define SYSTICK_CVR systick_hw->cvr
+#endif
+
+#define SYSTICK_CSR_ENABLE (1u << 0)
+#define SYSTICK_CSR_CLKSOURCE_PROCESSOR (1u << 2)
+#define SYSTICK_MAX_RELOAD 0x00ffffff
+
+/*
+Make sure SysTick counts sys clock cycles. If nobody uses SysTick,
+start it free running without interrupts. Returns false if it
+is already running from another clock source
+*/
+static bool dmx_output_group_systick_init()
+{
+    uint32_t csr = SYSTICK_CSR;
+
+    if (!(csr & SYSTICK_CSR_ENABLE))
+    {
+        SYSTICK_RVR = SYSTICK_MAX_RELOAD;
+        SYSTICK_CVR = 0;
+        SYSTICK_CSR = SYSTICK_CSR_CLKSOURCE_PROCESSOR | SYSTICK_CSR_ENABLE;
+        return true;
+    }
+
+    return (csr & SYSTICK_CSR_CLKSOURCE_PROCESSOR) != 0;
+}
+
+DmxOutputGroup::return_code DmxOutputGroup::add(DmxOutput *output)
+{
+    // Only started outputs have a state machine and DMA channel to arm
+    if (output == nullptr || !output->_active)
+    {
+        return ERR_INVALID_OUTPUT;
+    }
+
+    for (uint i = 0; i < _num_outputs; i++)
+    {
+        if (_outputs[i] == output)
+        {
+            return ERR_DUPLICATE_OUTPUT;
+        }
+    }
+
+    if (_num_outputs >= DMX_OUTPUT_GROUP_MAX_OUTPUTS)
+    {
+        return ERR_GROUP_FULL;
+    }
+
+    _outputs[_num_outputs++] = output;
+
+    return SUCCESS;
+}
+
+void DmxOutputGroup::clear()
+{
+    _num_outputs = 0;
+}
+
+void DmxOutputGroup::write(uint8_t *universes[], uint length)
+{
+    // One state machine mask per PIO instance, and one mask for all DMA channels
+    uint32_t sm_masks[NUM_PIOS] = {0};
+    uint32_t dma_mask = 0;
+
+    for (uint i = 0; i < _num_outputs; i++)
+    {
+        DmxOutput *output = _outputs[i];
+
+        // Skip outputs that have been ended since they were added
+        if (!output->_active)
+            continue;
+
+        // Halt the PIO state machine and reset it to a consistent state
+        pio_sm_set_enabled(output->_pio, output->_sm, false);
+        pio_sm_restart(output->_pio, output->_sm);
+        pio_sm_clear_fifos(output->_pio, output->_sm);
+
+        // Point the state machine at the start of the DMX PIO program
+        pio_sm_exec(output->_pio, output->_sm, pio_encode_jmp(output->_prgm_offset));
+
+        // Prepare the DMA transfer without triggering it
+        dma_channel_set_read_addr(output->_dma, universes[i], false);
+        dma_channel_set_trans_count(output->_dma, length, false);
+
+        sm_masks[pio_get_index(output->_pio)] |= 1u << output->_sm;
+        dma_mask |= 1u << output->_dma;
+    }
+
+    // Trigger all DMA channels with a single register write. The DMA fills
+    // the TX FIFOs while the state machines are still halted, so no data
+    // leaves the pins before the state machines are enabled below
+    dma_start_channel_mask(dma_mask);
+
+    // Collect the PIO instances that have outputs in the group
+    PIO pios[NUM_PIOS];
+    uint32_t pio_masks[NUM_PIOS];
+    uint num_pios = 0;
+    for (uint pio_ind = 0; pio_ind < NUM_PIOS; pio_ind++)
+    {
+        if (sm_masks[pio_ind] != 0)
+        {
+            pios[num_pios] = pio_get_instance(pio_ind);
+            pio_masks[num_pios] = sm_masks[pio_ind];
+            num_pios++;
+        }
+    }
+
+    if (num_pios <= 1)
+    {
+        // All state machines share a single enable write, and the clock
+        // dividers are restarted in the same cycle
+        if (num_pios == 1)
+        {
+            pio_enable_sm_mask_in_sync(pios[0], pio_masks[0]);
+        }
+        _skew_cycles = 0;
+        return;
+    }
+
+    // Enable the state machines of each PIO instance back to back, and
+    // count the sys clock cycles from the first to the last enable write
+    bool systick_ok = dmx_output_group_systick_init();
+    uint32_t reload = SYSTICK_RVR;
+
+    uint32_t irq_status = save_and_disable_interrupts();
+    pio_enable_sm_mask_in_sync(pios[0], pio_masks[0]);
+    uint32_t start = SYSTICK_CVR;
+    for (uint i = 1; i < num_pios; i++)
+    {
+        pio_enable_sm_mask_in_sync(pios[i], pio_masks[i]);
+    }
+    uint32_t stop = SYSTICK_CVR;
+    restore_interrupts(irq_status);
+
+    if (!systick_ok)
+    {
+        _skew_cycles = DMX_OUTPUT_GROUP_SKEW_UNKNOWN;
+        return;
+    }
+
+    // SysTick counts down, and wraps from 0 to the reload value
+    _skew_cycles = start >= stop ? start - stop : start + reload + 1 - stop;
+}
+
+void DmxOutputGroup::write(uint8_t *universe, uint length)
+{
+    uint8_t *universes[DMX_OUTPUT_GROUP_MAX_OUTPUTS];
+
+    for (uint i = 0; i < _num_outputs; i++)
+    {
+        universes[i] = universe;
+    }
+
+    write(universes, length);
+}
+
+bool DmxOutputGroup::busy()
+{
+    for (uint i = 0; i < _num_outputs; i++)
+    {
+        if (_outputs[i]->_active && _outputs[i]->busy())
+            return true;
+    }
+
+    return false;
+}
+
+uint32_t DmxOutputGroup::skew_cycles()
+{
+    return _skew_cycles;
+}
+
+uint DmxOutputGroup::size()
+{
+    return _num_outputs;
+}
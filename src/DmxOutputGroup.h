@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef DMX_OUTPUT_GROUP_H
+#define DMX_OUTPUT_GROUP_H
+
+#include "DmxOutput.h"
+
+// One output per state machine on every PIO instance
+#define DMX_OUTPUT_GROUP_MAX_OUTPUTS (NUM_PIOS * NUM_PIO_STATE_MACHINES)
+
+// Returned by skew_cycles() when SysTick is not counting sys clock cycles
+#define DMX_OUTPUT_GROUP_SKEW_UNKNOWN 0xffffffff
+
+class DmxOutputGroup
+{
+    DmxOutput *_outputs[DMX_OUTPUT_GROUP_MAX_OUTPUTS];
+    uint _num_outputs = 0;
+    uint32_t _skew_cycles = 0;
+
+public:
+    /*
+        All different return codes for the DMX output group class.
+    */
+    enum return_code
+    {
+        SUCCESS = 0,
+
+        // The group already holds the maximum number of outputs
+        ERR_GROUP_FULL = -1,
+
+        // The output is a null pointer, or has not been started
+        ERR_INVALID_OUTPUT = -2,
+
+        // The output is already in the group
+        ERR_DUPLICATE_OUTPUT = -3
+    };
+
+    /*
+        Adds a DMX output to the group. The output must already
+        have been started with .begin(...). Outputs on different
+        PIO instances can be mixed in the same group. Outputs that
+        are ended later are skipped by the group.
+
+        Param: output
+        A pointer to the DMX output that should be added. The
+        output must outlive the group.
+    */
+    return_code add(DmxOutput *output);
+
+    /*
+        Removes all outputs from the group. The outputs themselves
+        are left running.
+    */
+    void clear();
+
+    /*
+        Write one DMX universe per output and start all outputs
+        in sync. All state machines are armed and their DMA channels
+        primed first, then the state machines of each PIO instance are
+        enabled with a single register write. Returns immediately and
+        does not block.
+
+        Param: universes
+        An array with one pointer to a DMX frame per output, in the
+        order the outputs were added to the group.
+
+        Param: length
+        The number of bytes from each DMX frame that should be
+        transmitted
+    */
+    void write(uint8_t *universes[], uint length);
+
+    /*
+        Write the same DMX universe to all outputs in the group and
+        start them in sync.
+    */
+    void write(uint8_t *universe, uint length);
+
+    /*
+        Checks whether any output in the group is busy sending
+        a DMX data frame. Returns immediately
+    */
+    bool busy();
+
+    /*
+        Get the number of sys clock cycles between enabling the first
+        and the last PIO instance in the latest .write(...) call, as
+        counted by SysTick. This includes the few cycles it takes to
+        read the counter, so it is an upper bound on the skew. All
+        outputs on the same PIO instance start in the same cycle, so
+        the result is 0 when the group uses a single PIO instance.
+
+        If SysTick is disabled, it is started free running from the
+        sys clock. If it already runs from another clock source, the
+        skew is reported as DMX_OUTPUT_GROUP_SKEW_UNKNOWN
+    */
+    uint32_t skew_cycles();
+
+    /*
+        Get the number of outputs in the group
+    */
+    uint size();
+};
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "DmxSystem.h"
+#include "DmxOutput.pio.h"
+
+DmxSystem::return_code DmxSystem::begin(const DmxOutputConfig *configs, uint num_configs)
+{
+    if (num_configs > DMX_SYSTEM_MAX_OUTPUTS)
+    {
+        return ERR_TOO_MANY_OUTPUTS;
+    }
+
+    /*
+    Check that every config names its own output and pin, and that
+    no output is running outside of this system
+    */
+
+    for (uint i = 0; i < num_configs; i++)
+    {
+        DmxOutput *output = configs[i].output;
+
+        if (output == nullptr || configs[i].pin >= NUM_BANK0_GPIOS)
+        {
+            return ERR_INVALID_CONFIG;
+        }
+
+        for (uint j = 0; j < i; j++)
+        {
+            if (configs[j].output == output || configs[j].pin == configs[i].pin)
+            {
+                return ERR_INVALID_CONFIG;
+            }
+        }
+
+        if (output->_active && !_owns_output(output))
+        {
+            return ERR_OUTPUT_IN_USE;
+        }
+    }
+
+    /*
+    Check that all resources are available before claiming anything.
+    Resources held by the running outputs of this system count as
+    available, as they are released before the new outputs are started
+    */
+
+    uint sms_needed[NUM_PIOS] = {0};
+    for (uint i = 0; i < num_configs; i++)
+    {
+        sms_needed[pio_get_index(configs[i].pio)]++;
+    }
+
+    uint sms_held[NUM_PIOS] = {0};
+    for (uint i = 0; i < _num_outputs; i++)
+    {
+        sms_held[pio_get_index(_outputs[i]->_pio)]++;
+    }
+
+    for (uint pio_ind = 0; pio_ind < NUM_PIOS; pio_ind++)
+    {
+        if (sms_needed[pio_ind] == 0)
+            continue;
+
+        PIO pio = pio_get_instance(pio_ind);
+
+        uint sms_free = sms_held[pio_ind];
+        for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++)
+        {
+            if (!pio_sm_is_claimed(pio, sm))
+                sms_free++;
+        }
+        if (sms_free < sms_needed[pio_ind])
+        {
+            return ERR_NO_SM_AVAILABLE;
+        }
+
+        if (!_prgm_loaded[pio_ind] && !pio_can_add_program(pio, &DmxOutput_program))
+        {
+            return ERR_INSUFFICIENT_PRGM_MEM;
+        }
+    }
+
+    uint dma_free = _num_outputs;
+    for (uint dma = 0; dma < NUM_DMA_CHANNELS; dma++)
+    {
+        if (!dma_channel_is_claimed(dma))
+            dma_free++;
+    }
+    if (dma_free < num_configs)
+    {
+        return ERR_NO_DMA_AVAILABLE;
+    }
+
+    /*
+    Everything fits. Stop the running outputs and claim the
+    resources for the new ones
+    */
+
+    end();
+
+    int sms[DMX_SYSTEM_MAX_OUTPUTS];
+    int dmas[DMX_SYSTEM_MAX_OUTPUTS];
+    return_code result = SUCCESS;
+
+    for (uint i = 0; i < num_configs; i++)
+    {
+        sms[i] = pio_claim_unused_sm(configs[i].pio, false);
+        dmas[i] = dma_claim_unused_channel(false);
+
+        if (sms[i] == -1)
+            result = ERR_NO_SM_AVAILABLE;
+        if (dmas[i] == -1)
+            result = ERR_NO_DMA_AVAILABLE;
+    }
+
+    if (result != SUCCESS)
+    {
+        // Someone else claimed resources after the check. Roll back
+        for (uint i = 0; i < num_configs; i++)
+        {
+            if (sms[i] != -1)
+                pio_sm_unclaim(configs[i].pio, sms[i]);
+            if (dmas[i] != -1)
+                dma_channel_unclaim(dmas[i]);
+        }
+        return result;
+    }
+
+    // Load the DMX PIO program once per PIO instance
+    for (uint pio_ind = 0; pio_ind < NUM_PIOS; pio_ind++)
+    {
+        if (sms_needed[pio_ind] > 0)
+        {
+            PIO pio = pio_get_instance(pio_ind);
+            _prgm_offsets[pio_ind] = pio_add_program(pio, &DmxOutput_program);
+            _prgm_loaded[pio_ind] = true;
+        }
+    }
+
+    // Configure all outputs in one pass
+    for (uint i = 0; i < num_configs; i++)
+    {
+        DmxOutput *output = configs[i].output;
+        uint pio_ind = pio_get_index(configs[i].pio);
+
+        output->_configure(configs[i].pin, configs[i].pio, sms[i], _prgm_offsets[pio_ind], dmas[i]);
+        output->_owns_prgm = false;
+
+        _outputs[_num_outputs++] = output;
+        _group.add(output);
+    }
+
+    return SUCCESS;
+}
+
+bool DmxSystem::_owns_output(DmxOutput *output)
+{
+    for (uint i = 0; i < _num_outputs; i++)
+    {
+        if (_outputs[i] == output)
+            return true;
+    }
+
+    return false;
+}
+
+DmxOutputGroup &DmxSystem::group()
+{
+    return _group;
+}
+
+void DmxSystem::end()
+{
+    for (uint i = 0; i < _num_outputs; i++)
+    {
+        _outputs[i]->end();
+    }
+    _num_outputs = 0;
+    _group.clear();
+
+    // Remove the shared DMX PIO programs from the PIO program memory
+    for (uint pio_ind = 0; pio_ind < NUM_PIOS; pio_ind++)
+    {
+        if (_prgm_loaded[pio_ind])
+        {
+            PIO pio = pio_get_instance(pio_ind);
+            pio_remove_program(pio, &DmxOutput_program, _prgm_offsets[pio_ind]);
+            _prgm_loaded[pio_ind] = false;
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef DMX_SYSTEM_H
+#define DMX_SYSTEM_H
+
+#include "DmxOutput.h"
+#include "DmxOutputGroup.h"
+
+#define DMX_SYSTEM_MAX_OUTPUTS DMX_OUTPUT_GROUP_MAX_OUTPUTS
+
+/*
+    The configuration of a single DMX output in a DMX system
+*/
+struct DmxOutputConfig
+{
+    // The DMX output instance to start
+    DmxOutput *output;
+
+    // Any valid GPIO pin on the RPi Pico
+    uint pin;
+
+    // The PIO instance to run the output on
+    PIO pio;
+};
+
+class DmxSystem
+{
+    DmxOutput *_outputs[DMX_SYSTEM_MAX_OUTPUTS];
+    uint _num_outputs = 0;
+    bool _prgm_loaded[NUM_PIOS] = {false};
+    uint _prgm_offsets[NUM_PIOS];
+    DmxOutputGroup _group;
+
+    // Whether the output is one of the running outputs of this system
+    bool _owns_output(DmxOutput *output);
+
+public:
+    /*
+        All different return codes for the DMX system class. The codes
+        shared with DmxOutput have the same values. Unless SUCCESS is
+        returned, the system holds no new resources
+    */
+    enum return_code
+    {
+        SUCCESS = 0,
+
+        // There are not enough available state machines left
+        // in one of the pio instances
+        ERR_NO_SM_AVAILABLE = -1,
+
+        // There is not enough program memory left in one of the
+        // PIO instances to fit the DMX PIO program
+        ERR_INSUFFICIENT_PRGM_MEM = -2,
+
+        // There are not enough available DMA channels to handle
+        // all the outputs
+        ERR_NO_DMA_AVAILABLE = -3,
+
+        // More outputs were requested than the Pico can run
+        ERR_TOO_MANY_OUTPUTS = -4,
+
+        // A config has no output or an invalid pin, or lists
+        // an output or pin that is already used by another config
+        ERR_INVALID_CONFIG = -5,
+
+        // An output was already started with DmxOutput::begin(...)
+        // or by another DMX system
+        ERR_OUTPUT_IN_USE = -6
+    };
+
+    /*
+        Starts a set of DMX outputs in one pass. All PIO program
+        memory, state machines and DMA channels needed are checked
+        up front, and only then claimed and configured. The DMX PIO
+        program is loaded once per PIO instance and shared between
+        the outputs.
+
+        Calling .begin(...) on a running system reconfigures it. The
+        resources of the running outputs count as available, and the
+        running outputs are only stopped once the new configuration
+        is known to fit. If the check fails, the running outputs are
+        left untouched.
+
+        Param: configs
+        An array with the configuration of each output
+
+        Param: num_configs
+        The number of outputs in the array
+    */
+    return_code begin(const DmxOutputConfig *configs, uint num_configs);
+
+    /*
+        Get a group of all outputs in the system, for writing
+        universes to them in sync
+    */
+    DmxOutputGroup &group();
+
+    /*
+        De-inits all DMX outputs in the system and releases all
+        PIO and DMA resources
+    */
+    void end();
+};
+
+#endif
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "DmxUsbStream.h"
+
+#include <string.h>
+
+DmxUsbStream::return_code DmxUsbStream::attach(uint port, DmxOutput *output, uint8_t *frame)
+{
+    if (port >= DMX_USB_STREAM_MAX_PORTS)
+    {
+        return ERR_INVALID_PORT;
+    }
+
+    if (output != nullptr && frame == nullptr)
+    {
+        return ERR_INVALID_FRAME;
+    }
+
+    _outputs[port] = output;
+    _frames[port] = frame;
+
+    return SUCCESS;
+}
+
+uint8_t *DmxUsbStream::_next_chunk(uint *max_length)
+{
+    // Hold back the next batch until the reply to the previous one is taken
+    if (_reply_pending)
+    {
+        return nullptr;
+    }
+
+    switch (_state)
+    {
+    case STATE_BATCH_HEADER:
+        *max_length = DMX_USB_STREAM_BATCH_HEADER_SIZE - _header_pos;
+        return _header + _header_pos;
+
+    case STATE_RECORD_HEADER:
+        *max_length = DMX_USB_STREAM_RECORD_HEADER_SIZE - _header_pos;
+        return _header + _header_pos;
+
+    case STATE_PAYLOAD:
+        // Don't touch the frame buffer while it is being transmitted
+        if (_payload_pos == 0 && _outputs[_port]->busy())
+        {
+            return nullptr;
+        }
+        *max_length = _payload_length - _payload_pos;
+        return _frames[_port] + _payload_pos;
+
+    case STATE_DISCARD:
+        // Throw the payload away through the header buffer
+        *max_length = _payload_length - _payload_pos;
+        if (*max_length > sizeof(_header))
+        {
+            *max_length = sizeof(_header);
+        }
+        return _header;
+    }
+
+    return nullptr;
+}
+
+void DmxUsbStream::_commit(uint length)
+{
+    switch (_state)
+    {
+    case STATE_BATCH_HEADER:
+        _header_pos += length;
+        if (_header_pos < DMX_USB_STREAM_BATCH_HEADER_SIZE)
+        {
+            return;
+        }
+
+        if (_header[0] == DMX_USB_STREAM_MAGIC_0 && _header[1] == DMX_USB_STREAM_MAGIC_1 && _header[2] > 0)
+        {
+            _records_left = _header[2];
+            _sequence = _header[3];
+            _batch_ok = true;
+            _header_pos = 0;
+            _state = STATE_RECORD_HEADER;
+            return;
+        }
+
+        // Lost sync. Drop bytes up to the next possible start of a batch header
+        _errors++;
+        {
+            uint skip = 1;
+            while (skip < _header_pos && _header[skip] != DMX_USB_STREAM_MAGIC_0)
+            {
+                skip++;
+            }
+            memmove(_header, _header + skip, _header_pos - skip);
+            _header_pos -= skip;
+        }
+        return;
+
+    case STATE_RECORD_HEADER:
+        _header_pos += length;
+        if (_header_pos < DMX_USB_STREAM_RECORD_HEADER_SIZE)
+        {
+            return;
+        }
+
+        _header_pos = 0;
+        _port = _header[0];
+        _payload_pos = 0;
+        _payload_length = _header[1] | (_header[2] << 8);
+
+        if (_port < DMX_USB_STREAM_MAX_PORTS && _outputs[_port] != nullptr &&
+            _payload_length > 0 && _payload_length <= DMX_UNIVERSE_SIZE + 1)
+        {
+            _state = STATE_PAYLOAD;
+            return;
+        }
+
+        _errors++;
+        _batch_ok = false;
+        if (_payload_length == 0)
+        {
+            _finish_record();
+            return;
+        }
+        _state = STATE_DISCARD;
+        return;
+
+    case STATE_PAYLOAD:
+        _payload_pos += length;
+        if (_payload_pos == _payload_length)
+        {
+            _lengths[_port] = _payload_length;
+            _pending_ports |= 1u << _port;
+            _finish_record();
+        }
+        return;
+
+    case STATE_DISCARD:
+        _payload_pos += length;
+        if (_payload_pos == _payload_length)
+        {
+            _finish_record();
+        }
+        return;
+    }
+}
+
+void DmxUsbStream::_finish_record()
+{
+    if (--_records_left > 0)
+    {
+        _state = STATE_RECORD_HEADER;
+        return;
+    }
+
+    // The batch is complete. Send all received universes
+    for (uint port = 0; port < DMX_USB_STREAM_MAX_PORTS; port++)
+    {
+        if (_pending_ports & (1u << port))
+        {
+            _outputs[port]->write(_frames[port], _lengths[port]);
+        }
+    }
+    _pending_ports = 0;
+
+    _reply[0] = _batch_ok ? DMX_USB_STREAM_ACK : DMX_USB_STREAM_NAK;
+    _reply[1] = _sequence;
+    _reply_pending = true;
+
+    _batches++;
+    _state = STATE_BATCH_HEADER;
+}
+
+size_t DmxUsbStream::feed(const uint8_t *data, size_t length)
+{
+    size_t consumed = 0;
+
+    while (consumed < length)
+    {
+        uint max_length;
+        uint8_t *chunk = _next_chunk(&max_length);
+        if (chunk == nullptr)
+        {
+            break;
+        }
+
+        if (max_length > length - consumed)
+        {
+            max_length = length - consumed;
+        }
+        memcpy(chunk, data + consumed, max_length);
+        _commit(max_length);
+        consumed += max_length;
+    }
+
+    return consumed;
+}
+
+#ifdef ARDUINO
+size_t DmxUsbStream::poll(Stream &stream)
+{
+    size_t consumed = 0;
+
+    for (;;)
+    {
+        // Send the reply to a completed batch before reading the next one
+        uint8_t reply[DMX_USB_STREAM_REPLY_SIZE];
+        if (take_reply(reply))
+        {
+            stream.write(reply, DMX_USB_STREAM_REPLY_SIZE);
+        }
+
+        int available = stream.available();
+        if (available <= 0)
+        {
+            break;
+        }
+
+        uint max_length;
+        uint8_t *chunk = _next_chunk(&max_length);
+        if (chunk == nullptr)
+        {
+            break;
+        }
+
+        if (max_length > (uint)available)
+        {
+            max_length = available;
+        }
+        uint length = stream.readBytes(chunk, max_length);
+        _commit(length);
+        consumed += length;
+    }
+
+    return consumed;
+}
+#endif
+
+bool DmxUsbStream::take_reply(uint8_t *reply)
+{
+    if (!_reply_pending)
+    {
+        return false;
+    }
+
+    memcpy(reply, _reply, DMX_USB_STREAM_REPLY_SIZE);
+    _reply_pending = false;
+
+    return true;
+}
+
+uint32_t DmxUsbStream::batches()
+{
+    return _batches;
+}
+
+uint32_t DmxUsbStream::errors()
+{
+    return _errors;
+}
+
+void DmxUsbStream::reset()
+{
+    _state = STATE_BATCH_HEADER;
+    _header_pos = 0;
+    _pending_ports = 0;
+}
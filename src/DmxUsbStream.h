@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021 Jostein Løwer 
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef DMX_USB_STREAM_H
+#define DMX_USB_STREAM_H
+
+#if defined(ARDUINO_ARCH_MBED)
+  #include <Arduino.h>
+#endif
+
+#include "DmxOutput.h"
+
+#define DMX_USB_STREAM_MAX_PORTS 8
+
+/*
+    Wire format of the stream. A batch carries one or more universes:
+
+    Batch header (4 bytes):  'D' 'X' <record count> <sequence number>
+    Record header (3 bytes): <port> <length low byte> <length high byte>
+    Record payload:          <length> bytes, start code first
+
+    When a batch is complete, all universes in it are written to their
+    DMX outputs and a 2 byte reply is sent back to the host:
+    <ACK or NAK> <sequence number>
+*/
+#define DMX_USB_STREAM_MAGIC_0 0x44
+#define DMX_USB_STREAM_MAGIC_1 0x58
+#define DMX_USB_STREAM_BATCH_HEADER_SIZE 4
+#define DMX_USB_STREAM_RECORD_HEADER_SIZE 3
+#define DMX_USB_STREAM_REPLY_SIZE 2
+#define DMX_USB_STREAM_ACK 0x06
+#define DMX_USB_STREAM_NAK 0x15
+
+class DmxUsbStream
+{
+    enum state
+    {
+        STATE_BATCH_HEADER,
+        STATE_RECORD_HEADER,
+        STATE_PAYLOAD,
+        STATE_DISCARD
+    };
+
+    DmxOutput *_outputs[DMX_USB_STREAM_MAX_PORTS] = {nullptr};
+    uint8_t *_frames[DMX_USB_STREAM_MAX_PORTS] = {nullptr};
+    uint _lengths[DMX_USB_STREAM_MAX_PORTS] = {0};
+    uint32_t _pending_ports = 0;
+
+    state _state = STATE_BATCH_HEADER;
+    uint8_t _header[DMX_USB_STREAM_BATCH_HEADER_SIZE];
+    uint _header_pos = 0;
+    uint _records_left = 0;
+    uint8_t _sequence = 0;
+    bool _batch_ok = true;
+    uint _port = 0;
+    uint _payload_pos = 0;
+    uint _payload_length = 0;
+
+    uint8_t _reply[DMX_USB_STREAM_REPLY_SIZE];
+    bool _reply_pending = false;
+
+    uint32_t _batches = 0;
+    uint32_t _errors = 0;
+
+    uint8_t *_next_chunk(uint *max_length);
+    void _commit(uint length);
+    void _finish_record();
+
+public:
+    /*
+        All different return codes for the DMX USB stream class.
+    */
+    enum return_code
+    {
+        SUCCESS = 0,
+
+        // The port number is out of range
+        ERR_INVALID_PORT = -1,
+
+        // An output was given without a frame buffer
+        ERR_INVALID_FRAME = -2
+    };
+
+    /*
+        Binds a port number in the stream to a DMX output.
+
+        Param: port
+        The port number used by the host, from 0 to 7
+
+        Param: output
+        A DMX output that has already been started with .begin(...)
+
+        Param: frame
+        The frame buffer the received universes are written to. Payloads
+        are copied straight from the stream into this buffer, so it must
+        hold a full DMX frame of 513 bytes.
+
+        Pass nullptr for both output and frame to detach the port.
+    */
+    return_code attach(uint port, DmxOutput *output, uint8_t *frame);
+
+    /*
+        Feed received bytes into the stream. Payloads are copied in
+        bulk into the frame buffer of their port.
+
+        Returns the number of bytes consumed. If this is less than
+        length, the stream is either waiting for a DMX output that is
+        still busy transmitting, or it has completed a batch whose
+        reply has not been taken with .take_reply(...) yet. Take the
+        reply, and feed the remaining bytes again. A busy output is
+        the back-pressure towards the host.
+    */
+    size_t feed(const uint8_t *data, size_t length);
+
+#ifdef ARDUINO
+    /*
+        Read all available bytes from a stream such as the USB serial
+        port. Payloads are read directly into the frame buffers, and
+        replies are written back to the same stream. Bytes are left in
+        the stream while a DMX output is busy, so the host is throttled
+        by the USB flow control.
+
+        Returns the number of bytes consumed
+    */
+    size_t poll(Stream &stream);
+#endif
+
+    /*
+        Get the reply for the latest completed batch. Returns false if
+        there is no new reply since the last call. Only needed when
+        using .feed(...), as .poll(...) sends the replies itself. The
+        stream consumes no further bytes until the reply is taken, so
+        no reply is ever lost.
+    */
+    bool take_reply(uint8_t *reply);
+
+    /*
+        Get the number of completed batches
+    */
+    uint32_t batches();
+
+    /*
+        Get the number of framing errors, such as lost sync or
+        records for ports that are not attached
+    */
+    uint32_t errors();
+
+    /*
+        Drop any partially received batch and wait for a new batch header
+    */
+    void reset();
+};
+
+#endif